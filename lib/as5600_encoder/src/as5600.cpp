@@ -30,7 +30,7 @@ uint16_t AS5600::angle() {
     if (closeTransactions) {
         setAngleRegister();
     }
-    _wire->requestFrom(_address, (uint8_t)2, (uint8_t)closeTransactions);
+    lastReadOk = (_wire->requestFrom(_address, (uint8_t)2, (uint8_t)closeTransactions) == 2);
     result = (_wire->read()&0x0F)<<8;
     result |= _wire->read();
     return result;
@@ -144,8 +144,8 @@ uint16_t AS5600::readRegister(uint8_t reg, uint8_t len){
     uint16_t result = 0;
     _wire->beginTransmission(_address);
     _wire->write(reg);
-    _wire->endTransmission(false);
-    _wire->requestFrom(_address, len, (uint8_t)closeTransactions);
+    lastReadOk = (_wire->endTransmission(false) == 0);
+    lastReadOk &= (_wire->requestFrom(_address, len, (uint8_t)closeTransactions) == len);
     result = _wire->read();
     if (len == 2) {
         result <<= 8;
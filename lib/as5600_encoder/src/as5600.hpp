@@ -93,9 +93,10 @@ public:
 
     bool closeTransactions = true;
     bool useHysteresis = true;
+    bool lastReadOk = false; // false if the last read was NACKed or returned too few bytes
     uint8_t _address;
 protected:
-    TwoWire* _wire;
+    TwoWire* _wire = nullptr;
 
     void setAngleRegister();
     uint16_t readRegister(uint8_t reg, uint8_t len);
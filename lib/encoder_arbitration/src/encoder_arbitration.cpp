@@ -0,0 +1,38 @@
+#include "encoder_arbitration.hpp"
+
+#include <math.h>
+
+namespace sensors::encoder
+{
+    static inline bool looksStuck(const ChannelEvidence& ev) {
+        return fabsf(ev.velocity_rad_s) < ENC_ARB_STUCK_VEL_RAD_S;
+    }
+
+    static inline bool looksSpinning(const ChannelEvidence& ev) {
+        return fabsf(ev.velocity_rad_s) >= ENC_ARB_SPIN_VEL_RAD_S;
+    }
+
+    uint8_t arbitrate(const ChannelEvidence& ch0, const ChannelEvidence& ch1, bool rotor_driven)
+    {
+        // the sensor's own diagnosis is the strongest evidence
+        uint8_t mask = 0;
+        if (ch0.status_valid && ch0.magnet_fault) mask |= 0x01;
+        if (ch1.status_valid && ch1.magnet_fault) mask |= 0x02;
+        if (mask != 0) {
+            return mask;
+        }
+
+        // a frozen reading next to one that is moving, or while the motor is commanded to spin
+        bool stuck0 = looksStuck(ch0);
+        bool stuck1 = looksStuck(ch1);
+        if (stuck0 && !stuck1 && (looksSpinning(ch1) || rotor_driven)) {
+            return 0x01;
+        }
+        if (stuck1 && !stuck0 && (looksSpinning(ch0) || rotor_driven)) {
+            return 0x02;
+        }
+
+        // no evidence either way, keep the primary
+        return 0x02;
+    }
+}
@@ -0,0 +1,26 @@
+#ifndef ENCODER_ARBITRATION_HPP
+#define ENCODER_ARBITRATION_HPP
+
+#include <stdint.h>
+
+#define ENC_ARB_STUCK_VEL_RAD_S 1.0f // below this a channel looks frozen (AS5600 noise is ~1 LSB per sample)
+#define ENC_ARB_SPIN_VEL_RAD_S 20.0f // above this a channel is clearly tracking a turning rotor
+
+// decides which of two disagreeing encoder channels to fault, from evidence each channel collected.
+// no Arduino dependencies so it can be compiled and tested on the host
+namespace sensors::encoder
+{
+    struct ChannelEvidence {
+        bool status_valid; // magnet status was read successfully during this disagreement
+        bool magnet_fault; // AS5600 reports no, weak or saturated magnet
+        float velocity_rad_s; // latest velocity estimate of the channel
+    };
+
+    // returns a bitmask of channels to fault (bit 0 = channel 0, bit 1 = channel 1), never 0:
+    //  1. a channel whose own magnet status reports a fault
+    //  2. a channel that looks frozen while the other tracks a turning rotor, or while the rotor is being driven
+    //  3. otherwise the secondary channel, so the primary keeps control
+    uint8_t arbitrate(const ChannelEvidence& ch0, const ChannelEvidence& ch1, bool rotor_driven);
+}
+
+#endif // ENCODER_ARBITRATION_HPP
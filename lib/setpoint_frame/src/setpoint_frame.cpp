@@ -0,0 +1,118 @@
+#include "setpoint_frame.hpp"
+
+#include <string.h>
+
+namespace comms::setpoint
+{
+    static inline void putU16(uint8_t* p, uint16_t v) {
+        p[0] = v & 0xFF;
+        p[1] = v >> 8;
+    }
+
+    static inline uint16_t getU16(const uint8_t* p) {
+        return (uint16_t)(p[0] | (p[1] << 8));
+    }
+
+    static inline int16_t toFixed(float value, float scale) {
+        float x = value * scale;
+        if (x > 32767.0f) x = 32767.0f;
+        if (x < -32768.0f) x = -32768.0f;
+        return (int16_t)(x < 0.0f ? x - 0.5f : x + 0.5f);
+    }
+
+    uint16_t crc16(const uint8_t* data, size_t len)
+    {
+        uint16_t crc = 0xFFFF;
+        for (size_t i = 0; i < len; i++) {
+            crc ^= (uint16_t)data[i] << 8;
+            for (int b = 0; b < 8; b++) {
+                crc = (crc & 0x8000) ? (uint16_t)((crc << 1) ^ 0x1021) : (uint16_t)(crc << 1);
+            }
+        }
+        return crc;
+    }
+
+    void encodeFrame(const Setpoint& sp, uint8_t* out)
+    {
+        float thrust = sp.thrust < 0.0f ? 0.0f : (sp.thrust > 1.0f ? 1.0f : sp.thrust);
+
+        out[0] = SETPOINT_SYNC0;
+        out[1] = SETPOINT_SYNC1;
+        putU16(&out[2], sp.seq);
+        putU16(&out[4], (uint16_t)toFixed(sp.roll, SETPOINT_ANGLE_SCALE));
+        putU16(&out[6], (uint16_t)toFixed(sp.pitch, SETPOINT_ANGLE_SCALE));
+        putU16(&out[8], (uint16_t)toFixed(sp.yaw, SETPOINT_ANGLE_SCALE));
+        putU16(&out[10], (uint16_t)(thrust * SETPOINT_THRUST_SCALE + 0.5f));
+        putU16(&out[12], crc16(&out[2], SETPOINT_PAYLOAD_SIZE));
+    }
+
+    void FrameDecoder::reset()
+    {
+        _len = 0;
+    }
+
+    bool FrameDecoder::feed(uint8_t byte, Setpoint& out)
+    {
+        // hunt for the sync sequence
+        if (_len == 0) {
+            if (byte == SETPOINT_SYNC0) {
+                _buf[_len++] = byte;
+            }
+            return false;
+        }
+        if (_len == 1) {
+            if (byte == SETPOINT_SYNC1) {
+                _buf[_len++] = byte;
+            } else {
+                _len = (byte == SETPOINT_SYNC0) ? 1 : 0;
+            }
+            return false;
+        }
+
+        _buf[_len++] = byte;
+        if (_len < SETPOINT_FRAME_SIZE) {
+            return false;
+        }
+
+        if (crc16(&_buf[2], SETPOINT_PAYLOAD_SIZE) != getU16(&_buf[12])) {
+            crc_errors++;
+            // the sync bytes may have been payload, rescan the rest of the buffer for a new frame start
+            // (at most FRAME_SIZE - 1 bytes, so this can never complete a frame and recurse further)
+            uint8_t pending[SETPOINT_FRAME_SIZE - 1];
+            memcpy(pending, &_buf[1], sizeof(pending));
+            _len = 0;
+            for (uint8_t i = 0; i < sizeof(pending); i++) {
+                feed(pending[i], out);
+            }
+            return false;
+        }
+
+        out.seq = getU16(&_buf[2]);
+        out.roll = (int16_t)getU16(&_buf[4]) / SETPOINT_ANGLE_SCALE;
+        out.pitch = (int16_t)getU16(&_buf[6]) / SETPOINT_ANGLE_SCALE;
+        out.yaw = (int16_t)getU16(&_buf[8]) / SETPOINT_ANGLE_SCALE;
+        out.thrust = getU16(&_buf[10]) / SETPOINT_THRUST_SCALE;
+        _len = 0;
+        return true;
+    }
+
+    bool SequenceTracker::accept(uint16_t seq, uint32_t& lost)
+    {
+        lost = 0;
+        if (_have_seq) {
+            uint16_t gap = (uint16_t)(seq - _last_seq);
+            if (gap == 0 || gap >= 0x8000) {
+                return false;
+            }
+            lost = gap - 1;
+        }
+        _have_seq = true;
+        _last_seq = seq;
+        return true;
+    }
+
+    void SequenceTracker::reset()
+    {
+        _have_seq = false;
+    }
+}
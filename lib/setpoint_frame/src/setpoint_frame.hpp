@@ -0,0 +1,69 @@
+#ifndef SETPOINT_FRAME_HPP
+#define SETPOINT_FRAME_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+// fixed-size binary setpoint frame sent by an external flight controller
+// layout (little endian):
+//   [0]  0xA5 sync
+//   [1]  0x5A sync
+//   [2]  uint16 sequence number
+//   [4]  int16  roll   (x SETPOINT_ANGLE_SCALE)
+//   [6]  int16  pitch  (x SETPOINT_ANGLE_SCALE)
+//   [8]  int16  yaw    (x SETPOINT_ANGLE_SCALE)
+//   [10] uint16 thrust (x SETPOINT_THRUST_SCALE, 0 to 1)
+//   [12] uint16 CRC-16/CCITT-FALSE over bytes 2..11
+// no Arduino dependencies so the codec can be compiled and tested on the host
+
+#define SETPOINT_SYNC0 0xA5
+#define SETPOINT_SYNC1 0x5A
+#define SETPOINT_FRAME_SIZE 14
+#define SETPOINT_PAYLOAD_SIZE 10 // sequence number through thrust, covered by the CRC
+#define SETPOINT_ANGLE_SCALE 10000.0f
+#define SETPOINT_THRUST_SCALE 65535.0f
+
+namespace comms::setpoint
+{
+    struct Setpoint {
+        uint16_t seq;
+        float roll;
+        float pitch;
+        float yaw;
+        float thrust;
+    };
+
+    uint16_t crc16(const uint8_t* data, size_t len);
+
+    // write a frame into out (SETPOINT_FRAME_SIZE bytes), values are saturated to the representable range
+    void encodeFrame(const Setpoint& sp, uint8_t* out);
+
+    // streaming decoder, fed one byte at a time straight from the UART.
+    // resynchronizes on the sync bytes after any corrupted frame.
+    class FrameDecoder {
+    public:
+        // returns true when byte completes a valid frame, which is then written to out
+        bool feed(uint8_t byte, Setpoint& out);
+        void reset();
+
+        uint32_t crc_errors = 0;
+    private:
+        uint8_t _buf[SETPOINT_FRAME_SIZE];
+        uint8_t _len = 0;
+    };
+
+    // tracks the sequence number across frames, handling wraparound at 65535
+    class SequenceTracker {
+    public:
+        // returns false for duplicate or out of order frames (more than half the sequence space behind),
+        // otherwise sets lost to the number of frames skipped since the last accepted one
+        bool accept(uint16_t seq, uint32_t& lost);
+        // forget the last sequence number, e.g. after a timeout or sender reboot
+        void reset();
+    private:
+        bool _have_seq = false;
+        uint16_t _last_seq = 0;
+    };
+}
+
+#endif // SETPOINT_FRAME_HPP
@@ -0,0 +1,94 @@
+#include "thrust_map.hpp"
+
+#include <algorithm>
+#include <string.h>
+
+namespace control::thrust_map
+{
+    // DShot value at each segment boundary, indexed by normalized thrust
+    static uint16_t thrust_table[THRUST_MAP_SEGMENTS + 1];
+
+    static uint16_t fractionToDshot(float throttle_fraction)
+    {
+        throttle_fraction = std::max(0.0f, std::min(1.0f, throttle_fraction));
+        return static_cast<uint16_t>(THRUST_MAP_DSHOT_MIN + throttle_fraction * (THRUST_MAP_DSHOT_MAX - THRUST_MAP_DSHOT_MIN) + 0.5f);
+    }
+
+    void resetLinear()
+    {
+        for (int i = 0; i <= THRUST_MAP_SEGMENTS; i++) {
+            thrust_table[i] = fractionToDshot((float)i / THRUST_MAP_SEGMENTS);
+        }
+    }
+
+    bool fitFromSweep(const float* throttle, const float* thrust, size_t n)
+    {
+        if (n < 2) {
+            return false;
+        }
+        for (size_t i = 1; i < n; i++) {
+            if (throttle[i] <= throttle[i - 1]) {
+                return false; // sweep must be recorded with increasing throttle
+            }
+        }
+
+        // measured thrust is noisy, force it monotone with a running max so the curve is invertible
+        float thrust_min = thrust[0];
+        float thrust_max = thrust[0];
+        for (size_t i = 1; i < n; i++) {
+            thrust_max = std::max(thrust_max, thrust[i]);
+        }
+        if (thrust_max - thrust_min <= 0.0f) {
+            return false;
+        }
+
+        uint16_t new_table[THRUST_MAP_SEGMENTS + 1];
+        size_t seg = 0;
+        float seg_lo = 0.0f; // normalized, monotone thrust at sweep point seg
+        float seg_hi = (std::max(thrust_min, thrust[1]) - thrust_min) / (thrust_max - thrust_min);
+        float running_max = std::max(thrust_min, thrust[1]);
+
+        for (int k = 0; k <= THRUST_MAP_SEGMENTS; k++) {
+            float target = (float)k / THRUST_MAP_SEGMENTS;
+
+            // walk forward until the target lies inside [seg_lo, seg_hi]
+            while (target > seg_hi && seg + 2 < n) {
+                seg++;
+                seg_lo = seg_hi;
+                running_max = std::max(running_max, thrust[seg + 1]);
+                seg_hi = (running_max - thrust_min) / (thrust_max - thrust_min);
+            }
+
+            float t = 0.0f;
+            if (seg_hi > seg_lo) {
+                t = (target - seg_lo) / (seg_hi - seg_lo);
+                t = std::max(0.0f, std::min(1.0f, t));
+            }
+            float throttle_fraction = throttle[seg] + t * (throttle[seg + 1] - throttle[seg]);
+            new_table[k] = fractionToDshot(throttle_fraction);
+        }
+
+        memcpy(thrust_table, new_table, sizeof(thrust_table));
+        return true;
+    }
+
+    uint16_t thrustToDshot(float thrust_fraction)
+    {
+        // convert to fixed point, upper bits select the segment and lower bits interpolate within it
+        int32_t x = static_cast<int32_t>(thrust_fraction * THRUST_MAP_INPUT_SCALE);
+        x = std::max((int32_t)0, std::min((int32_t)THRUST_MAP_INPUT_SCALE, x));
+        uint32_t idx = (uint32_t)x >> THRUST_MAP_FRAC_BITS;
+        int32_t frac = x & ((1 << THRUST_MAP_FRAC_BITS) - 1);
+        if (idx >= THRUST_MAP_SEGMENTS) {
+            return thrust_table[THRUST_MAP_SEGMENTS];
+        }
+        int32_t lo = thrust_table[idx];
+        int32_t hi = thrust_table[idx + 1];
+        return static_cast<uint16_t>(lo + (((hi - lo) * frac) >> THRUST_MAP_FRAC_BITS));
+    }
+
+    const uint16_t* table()
+    {
+        return thrust_table;
+    }
+}
@@ -0,0 +1,36 @@
+#ifndef THRUST_MAP_HPP
+#define THRUST_MAP_HPP
+
+#include <stdint.h>
+#include <stddef.h>
+
+#define THRUST_MAP_SEGMENT_BITS 7 // 128 segments, fine enough to follow a quadratic curve near zero thrust
+#define THRUST_MAP_SEGMENTS (1 << THRUST_MAP_SEGMENT_BITS)
+#define THRUST_MAP_FRAC_BITS 10 // interpolation resolution within a segment
+#define THRUST_MAP_INPUT_SCALE (THRUST_MAP_SEGMENTS << THRUST_MAP_FRAC_BITS)
+
+#define THRUST_MAP_DSHOT_MIN 48 // DShot throttle range, named apart from DShotRMT's own constants
+#define THRUST_MAP_DSHOT_MAX 2047
+
+// maps a normalized thrust fraction [0, 1] to a DShot throttle value so that the
+// commanded value is (approximately) linear in rotor thrust.
+// the table is built by inverting a monotone throttle -> thrust curve recorded on a thrust stand.
+// no Arduino dependencies so the fit can be compiled and tested on the host
+namespace control::thrust_map
+{
+    // fit the table from a thrust stand sweep. throttle is the commanded fraction [0, 1]
+    // in increasing order, thrust is the measured thrust (any unit) at each point.
+    // returns false and keeps the current table if the sweep is unusable.
+    bool fitFromSweep(const float* throttle, const float* thrust, size_t n);
+
+    // reset to the linear (identity) map, one of these must run before the first lookup
+    void resetLinear();
+
+    // interpolated table lookup, constant time: one multiply, the input clamp and an end of table check
+    uint16_t thrustToDshot(float thrust_fraction);
+
+    // read back the table, e.g. for printing over serial
+    const uint16_t* table();
+}
+
+#endif // THRUST_MAP_HPP
@@ -0,0 +1,84 @@
+# PlatformIO post-build script: report where the control hot path ended up in memory
+# (IRAM / DRAM / flash) and how much static RAM the task stacks and buffers take.
+
+Import("env")
+
+import os
+import subprocess
+
+# functions on the timer -> task -> DShot path
+HOT_PATH = [
+    "onEncoderTimer",
+    "onRotorControlTimer",
+    "encoderTask",
+    "rotorControlTask",
+    "setControlInputs",
+    "sendToDshot",
+    "thrustToDshot",
+]
+
+# statically allocated task stacks, control blocks and kernel objects
+STATIC_BUFFERS = ["_task_stack", "_task_buffer", "_mutex_buffer", "channels"]
+
+
+def region(section):
+    if section.startswith(".iram"):
+        return "IRAM"
+    if section.startswith(".dram") or section.startswith(".bss") or section.startswith(".data"):
+        return "DRAM"
+    if section.startswith(".flash"):
+        return "flash"
+    return section
+
+
+def read_symbols(objdump, elf):
+    # objdump -t columns: address, flags, section, size, name
+    out = subprocess.check_output([objdump, "-t", "-C", elf], universal_newlines=True)
+    for line in out.splitlines():
+        if "\t" not in line:
+            continue
+        section_size, name = line.split("\t", 1)
+        fields = section_size.split()
+        section = fields[-1]
+        size_name = name.split(None, 1)
+        if len(size_name) < 2:
+            continue
+        yield section, int(size_name[0], 16), size_name[1]
+
+
+def report(source, target, env):
+    elf = str(target[0])
+    cc = env.subst("$CC")
+    objdump = os.path.join(os.path.dirname(cc), os.path.basename(cc).replace("gcc", "objdump"))
+
+    try:
+        symbols = list(read_symbols(objdump, elf))
+    except (OSError, subprocess.CalledProcessError) as e:
+        print("hot path footprint: objdump failed (%s)" % e)
+        return
+
+    totals = {}
+    print("=== Hot path footprint ===")
+    for section, size, name in symbols:
+        if size == 0:
+            continue
+        short = name.split("(")[0].split("::")[-1]
+        if short in HOT_PATH:
+            where = region(section)
+            totals[where] = totals.get(where, 0) + size
+            print("  %-6s %6d B  %s" % (where, size, name))
+    for where, size in sorted(totals.items()):
+        print("  total %-6s %6d B" % (where, size))
+
+    print("=== Static task memory ===")
+    static_total = 0
+    for section, size, name in symbols:
+        if size == 0 or region(section) != "DRAM":
+            continue
+        if any(name.endswith(suffix) for suffix in STATIC_BUFFERS):
+            static_total += size
+            print("  %6d B  %s" % (size, name))
+    print("  total  %6d B" % static_total)
+
+
+env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", report)
@@ -0,0 +1,164 @@
+#include "setpoint_link.hpp"
+#include "setpoint_frame.hpp"
+#include "control/rotor_control.hpp"
+#include "diagnostics/memory.hpp"
+
+namespace comms::setpoint
+{
+    static HardwareSerial& linkSerial = Serial1;
+    static FrameDecoder decoder;
+    static SequenceTracker sequence;
+    static LinkStats stats;
+    static portMUX_TYPE stats_mux = portMUX_INITIALIZER_UNLOCKED;
+
+    static std::atomic<bool> armed{false};
+    static std::atomic<bool> active{false};
+    static std::atomic<bool> failsafe{false};
+    static std::atomic<uint32_t> rx_event_us{0};
+    static uint32_t last_frame_us = 0; // 0 until the first frame after start or a timeout
+
+    static StaticTask_t link_task_buffer;
+    static StackType_t link_task_stack[LINK_TASK_STACK_SIZE];
+
+    // exponential moving average weight for the interval and latency averages (1/16)
+    #define LINK_AVG_SHIFT 4
+
+    // called from the UART driver's event task whenever bytes arrive
+    static void onLinkReceive()
+    {
+        rx_event_us.store(micros(), std::memory_order_relaxed);
+        xTaskNotifyGive(linkTaskHandle);
+    }
+
+    void initLink()
+    {
+        Serial.println("[Setpoint Link]: Initializing UART link...");
+        linkSerial.setRxBufferSize(256);
+        linkSerial.begin(LINK_BAUD, SERIAL_8N1, LINK_RX_PIN, LINK_TX_PIN);
+        // fire the receive callback once a whole frame is in the FIFO, or after a short idle gap
+        linkSerial.setRxFIFOFull(SETPOINT_FRAME_SIZE);
+        linkSerial.setRxTimeout(2);
+
+        linkTaskHandle = xTaskCreateStatic(linkTask, "SetpointLinkTask", LINK_TASK_STACK_SIZE, NULL, 2,
+                                           link_task_stack, &link_task_buffer);
+        diagnostics::memory::registerTask(linkTaskHandle, LINK_TASK_STACK_SIZE);
+        linkSerial.onReceive(onLinkReceive, false);
+        Serial.println("[Setpoint Link]: Link initialized.");
+    }
+
+    // returns true if the frame was accepted, stale frames do not count towards the timeout.
+    // latency is only measured when rx_us is the receive event of this frame (0 otherwise)
+    static bool handleFrame(const Setpoint& sp, uint32_t rx_us)
+    {
+        uint32_t lost = 0;
+        if (!sequence.accept(sp.seq, lost)) {
+            portENTER_CRITICAL(&stats_mux);
+            stats.stale++;
+            portEXIT_CRITICAL(&stats_mux);
+            return false;
+        }
+
+        if (armed.load(std::memory_order_relaxed)) {
+            control::rotor::setControlInputs(sp.roll, sp.pitch, sp.yaw, sp.thrust);
+        }
+        active.store(true, std::memory_order_relaxed);
+
+        uint32_t now = micros();
+        uint32_t latency = now - rx_us;
+        uint32_t interval = now - last_frame_us;
+        bool first = (last_frame_us == 0);
+        last_frame_us = now;
+
+        portENTER_CRITICAL(&stats_mux);
+        stats.frames++;
+        stats.lost += lost;
+        if (rx_us != 0) {
+            stats.latency_max_us = std::max(stats.latency_max_us, latency);
+            stats.latency_avg_us += ((int32_t)latency - (int32_t)stats.latency_avg_us) >> LINK_AVG_SHIFT;
+        }
+        if (!first) {
+            stats.interval_max_us = std::max(stats.interval_max_us, interval);
+            stats.interval_avg_us += ((int32_t)interval - (int32_t)stats.interval_avg_us) >> LINK_AVG_SHIFT;
+        }
+        portEXIT_CRITICAL(&stats_mux);
+        return true;
+    }
+
+    void linkTask(void *pvParameters)
+    {
+        Setpoint sp;
+        uint32_t last_valid_ms = 0;
+
+        while (true)
+        {
+            // only the first frame completed after a receive event is timed against it,
+            // later frames in the same batch and poll wakeups have no matching timestamp
+            bool notified = ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(LINK_POLL_MS)) > 0;
+            uint32_t rx_us = notified ? rx_event_us.load(std::memory_order_relaxed) : 0;
+
+            while (linkSerial.available()) {
+                if (decoder.feed((uint8_t)linkSerial.read(), sp)) {
+                    if (handleFrame(sp, rx_us)) {
+                        last_valid_ms = millis();
+                    }
+                    rx_us = 0;
+                }
+            }
+            portENTER_CRITICAL(&stats_mux);
+            stats.crc_errors = decoder.crc_errors;
+            portEXIT_CRITICAL(&stats_mux);
+
+            // failsafe: the flight controller stopped talking, cut the rotor and wait for the console to re-arm
+            // failsafe is raised before active drops, so a reader that sees the link inactive also sees the failsafe
+            if (active.load(std::memory_order_relaxed) && millis() - last_valid_ms > LINK_TIMEOUT_MS) {
+                if (armed.exchange(false)) {
+                    control::rotor::setControlInputs(0.0f, 0.0f, 0.0f, 0.0f);
+                }
+                failsafe.store(true);
+                active.store(false);
+                decoder.reset();
+                sequence.reset(); // the flight controller may have rebooted and restarted its sequence
+                last_frame_us = 0; // don't count the outage as a frame interval
+                portENTER_CRITICAL(&stats_mux);
+                stats.timeouts++;
+                portEXIT_CRITICAL(&stats_mux);
+            }
+        }
+    }
+
+    void setArmed(bool value)
+    {
+        armed.store(value);
+    }
+
+    bool isActive()
+    {
+        return active.load();
+    }
+
+    bool takeFailsafe()
+    {
+        return failsafe.exchange(false);
+    }
+
+    LinkStats getStats()
+    {
+        portENTER_CRITICAL(&stats_mux);
+        LinkStats copy = stats;
+        portEXIT_CRITICAL(&stats_mux);
+        return copy;
+    }
+
+    void printStats()
+    {
+        LinkStats s = getStats();
+        Serial.printf("Link: %s, %s\n", isActive() ? "ACTIVE" : "inactive", armed.load() ? "armed" : "disarmed");
+        Serial.printf("  frames %lu, crc errors %lu, lost %lu\n",
+                      (unsigned long)s.frames, (unsigned long)s.crc_errors, (unsigned long)s.lost);
+        Serial.printf("  stale %lu, timeouts %lu\n", (unsigned long)s.stale, (unsigned long)s.timeouts);
+        Serial.printf("  interval avg %lu us max %lu us\n",
+                      (unsigned long)s.interval_avg_us, (unsigned long)s.interval_max_us);
+        Serial.printf("  latency avg %lu us max %lu us\n",
+                      (unsigned long)s.latency_avg_us, (unsigned long)s.latency_max_us);
+    }
+}
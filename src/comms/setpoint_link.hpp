@@ -0,0 +1,46 @@
+#ifndef SETPOINT_LINK_HPP
+#define SETPOINT_LINK_HPP
+
+#include <Arduino.h>
+#include <atomic>
+
+#define LINK_RX_PIN 17
+#define LINK_TX_PIN 21
+#define LINK_BAUD 460800 // 14 byte frames at 1 kHz need ~140 kbaud, leave headroom
+#define LINK_TIMEOUT_MS 50 // no valid frame for this long while active triggers the failsafe
+#define LINK_POLL_MS 5 // task wakes at least this often to check the timeout
+#define LINK_TASK_STACK_SIZE 4096 // bytes, only shrink based on high-water marks measured with the 'm' console command
+
+// binary setpoint channel for an external flight controller on UART1
+namespace comms::setpoint
+{
+    struct LinkStats {
+        uint32_t frames = 0;
+        uint32_t crc_errors = 0;
+        uint32_t lost = 0; // gaps in the sequence number
+        uint32_t stale = 0; // duplicate or out of order frames, dropped
+        uint32_t timeouts = 0;
+        uint32_t interval_max_us = 0; // between consecutive valid frames
+        uint32_t interval_avg_us = 0;
+        uint32_t latency_max_us = 0; // from UART receive event to setpoint applied
+        uint32_t latency_avg_us = 0;
+    };
+
+    inline TaskHandle_t linkTaskHandle = NULL;
+
+    void initLink();
+    void linkTask(void *pvParameters);
+
+    // setpoints are only applied to the rotor while armed
+    void setArmed(bool armed);
+    // true while valid frames are arriving within the timeout
+    bool isActive();
+    // returns true once after the link timed out while active.
+    // check isActive() first: the failsafe is raised before the link reports inactive
+    bool takeFailsafe();
+
+    LinkStats getStats();
+    void printStats();
+}
+
+#endif // SETPOINT_LINK_HPP
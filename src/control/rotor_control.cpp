@@ -1,5 +1,7 @@
 #include "rotor_control.hpp"
+#include "thrust_map.hpp"
 #include "sensors/encoder.hpp"
+#include "diagnostics/memory.hpp"
 
 #include "DShotRMT.h"
 
@@ -10,7 +12,18 @@ namespace control::rotor
 {
     DShotRMT motor1(MOTOR1_PIN, DSHOT150); // 1 motor for testing purposes
     static float control_input[4] = {0.0f, 0.0f, 0.0f, 0.0f}; // roll, pitch, yaw, thrust
-    static SemaphoreHandle_t control_mutex = xSemaphoreCreateMutex();
+    static SemaphoreHandle_t control_mutex = NULL;
+    static StaticSemaphore_t control_mutex_buffer;
+
+    static StaticTask_t rotor_task_buffer;
+    static StackType_t rotor_task_stack[ROTOR_TASK_STACK_SIZE];
+
+#ifdef THRUST_SWEEP_CALIBRATED
+    // thrust stand sweep used to linearize the throttle -> thrust response, must be measured on the actual motor/ESC
+    // throttle fraction in increasing order, thrust in any unit
+    static const float thrust_sweep_throttle[] = {THRUST_SWEEP_THROTTLE};
+    static const float thrust_sweep_thrust[]   = {THRUST_SWEEP_THRUST};
+#endif
     
 
     // timer interrupts
@@ -28,15 +41,30 @@ namespace control::rotor
     
     void initRotor()
     {
+        control_mutex = xSemaphoreCreateMutexStatic(&control_mutex_buffer);
+
         motor1.begin();
         motor1.sendThrottle(0);
 
+#ifdef THRUST_SWEEP_CALIBRATED
+        if (!thrust_map::fitFromSweep(thrust_sweep_throttle, thrust_sweep_thrust,
+                                      sizeof(thrust_sweep_throttle) / sizeof(thrust_sweep_throttle[0]))) {
+            Serial.println("[Rotor Controller]: WARNING - Invalid thrust sweep, using linear throttle map");
+            thrust_map::resetLinear();
+        }
+#else
+        // no measured sweep yet, keep the plain linear throttle map
+        thrust_map::resetLinear();
+#endif
+
         Serial.println("[Rotor Controller]: Initializing rotor control...");
         for(int i = 0; i < 300; i++) {  // 3 seconds of zero throttle
             delay(10);
         }
 
-        xTaskCreatePinnedToCore(rotorControlTask, "RotorControlTask", 4096, NULL, 3, &rotorTaskHandle, 0);
+        rotorTaskHandle = xTaskCreateStaticPinnedToCore(rotorControlTask, "RotorControlTask", ROTOR_TASK_STACK_SIZE, NULL, 3,
+                                                        rotor_task_stack, &rotor_task_buffer, 0);
+        diagnostics::memory::registerTask(rotorTaskHandle, ROTOR_TASK_STACK_SIZE);
     
         // create timer
         Serial.println("[Rotor Controller]: Setting up rotor control timer...");
@@ -71,12 +99,13 @@ namespace control::rotor
                 amplitude = AMP_OFFSET + sqrt(local_control_input[0] * local_control_input[0] + local_control_input[1] * local_control_input[1]);
                 phase = atan2(local_control_input[1], local_control_input[0]);
 
-                // convert to an oscillatory throttle response
+                // convert to an oscillatory thrust response (linearized to throttle in sendToDshot)
                 output_throttle_fraction = local_control_input[3] + amplitude * cos(sensors::encoder::enc_angle_rad.load() - phase);
             } else {
                 // no pitch or roll command, just set throttle directly
                 output_throttle_fraction = local_control_input[3];
             }
+            sensors::encoder::enc_rotor_driven.store(output_throttle_fraction > 0.0f, std::memory_order_relaxed);
             sendToDshot(output_throttle_fraction);
         }
     }
@@ -91,16 +120,33 @@ namespace control::rotor
         xSemaphoreGive(control_mutex);
     }
 
-    void sendToDshot(float throttle_fraction)
+    void sendToDshot(float thrust_fraction)
     { 
-        if (throttle_fraction <= 0.0f) {
+        if (thrust_fraction <= 0.0f) {
             
             return;
         }
-        // ensure throttle_fraction is within [0.0, 1.0]
-        throttle_fraction = std::max(0.0f, std::min(1.0f, throttle_fraction));
-        // convert to DShot value (48 to 2047 for throttle)
-        uint16_t dshot_value = static_cast<uint16_t>(48 + throttle_fraction * (2047 - 48));
+        // map thrust fraction to DShot value (48 to 2047 for throttle), clamped to [0.0, 1.0] by the map
+        uint16_t dshot_value = thrust_map::thrustToDshot(thrust_fraction);
         motor1.sendThrottle(dshot_value);
     }
+
+    float benchmarkThrustMap(uint32_t iterations)
+    {
+        if (iterations == 0) {
+            return 0.0f;
+        }
+        volatile uint16_t sink = 0; // keep the compiler from dropping the lookups
+        float step = 1.0f / iterations;
+        float input = 0.0f;
+
+        uint32_t start = ESP.getCycleCount();
+        for (uint32_t i = 0; i < iterations; i++) {
+            sink = thrust_map::thrustToDshot(input);
+            input += step;
+        }
+        uint32_t cycles = ESP.getCycleCount() - start;
+        (void)sink;
+        return (float)cycles / iterations;
+    }
 }
\ No newline at end of file
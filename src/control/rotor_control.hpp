@@ -3,6 +3,10 @@
 
 #define MOTOR1_PIN 20
 #define AMP_OFFSET 0.0f //  amplitude offset to overcome static friction of hinge
+//#define THRUST_SWEEP_CALIBRATED // fit the thrust map from the sweep below instead of mapping throttle linearly
+//#define THRUST_SWEEP_THROTTLE 0.0f, 0.1f, 0.2f // commanded throttle fraction at each sweep point
+//#define THRUST_SWEEP_THRUST 0.0f, 0.05f, 0.12f // measured thrust at each sweep point
+#define ROTOR_TASK_STACK_SIZE 4096 // bytes, only shrink based on high-water marks measured with the 'm' console command
 
 #include <Arduino.h>
 
@@ -13,7 +17,9 @@ namespace control::rotor
     void initRotor();
     void rotorControlTask(void *pvParameters);
     void setControlInputs(float roll, float pitch, float yaw, float thrust);
-    void sendToDshot(float throttle_percent);
+    void sendToDshot(float thrust_fraction);
+    // time the thrust map lookup over a sweep of inputs, returns the mean cost in CPU cycles per call
+    float benchmarkThrustMap(uint32_t iterations);
 }
 
 #endif // ROTOR_CONTROL_HPP
\ No newline at end of file
@@ -0,0 +1,156 @@
+#include "memory.hpp"
+
+#include <atomic>
+#include <stdarg.h>
+#include "esp_heap_caps.h"
+
+extern "C" {
+    void* __real_malloc(size_t size);
+    void* __real_calloc(size_t n, size_t size);
+    void* __real_realloc(void* ptr, size_t size);
+    void* __real_heap_caps_malloc(size_t size, uint32_t caps);
+    void* __real_heap_caps_calloc(size_t n, size_t size, uint32_t caps);
+    void* __real_heap_caps_realloc(void* ptr, size_t size, uint32_t caps);
+}
+
+namespace diagnostics::memory
+{
+    struct TaskEntry {
+        TaskHandle_t handle;
+        uint32_t stack_size;
+    };
+
+    static TaskEntry tasks[MEM_MAX_TASKS];
+    static uint8_t num_tasks = 0;
+
+    static std::atomic<bool> setup_complete{false};
+    static std::atomic<uint32_t> runtime_allocs{0};
+    static std::atomic<void*> last_alloc_caller{nullptr}; // return address of the latest runtime allocation
+    static uint32_t free_heap_at_setup = 0;
+
+    // called from the allocation hooks below, so it has to be in IRAM as well
+    static void IRAM_ATTR countAllocation(void* caller) {
+        if (setup_complete.load(std::memory_order_relaxed)) {
+            runtime_allocs.fetch_add(1, std::memory_order_relaxed);
+            last_alloc_caller.store(caller, std::memory_order_relaxed);
+        }
+    }
+
+    void registerTask(TaskHandle_t handle, uint32_t stack_size)
+    {
+        if (handle == NULL || num_tasks >= MEM_MAX_TASKS) {
+            return;
+        }
+        tasks[num_tasks].handle = handle;
+        tasks[num_tasks].stack_size = stack_size;
+        num_tasks++;
+    }
+
+    void markSetupComplete()
+    {
+        // the Arduino loop task is created by the core, add it here since setup() runs on it
+        registerTask(xTaskGetCurrentTaskHandle(), getArduinoLoopTaskStackSize());
+
+        // newlib sets up its per-task dtoa buffers (through _calloc_r, which the hooks don't see)
+        // the first time a task formats a float, do that now so loop()'s first %.3f print isn't counted
+        char warmup[16];
+        snprintf(warmup, sizeof(warmup), "%.3f", 1.0f / 3.0f);
+
+        free_heap_at_setup = heap_caps_get_free_size(MALLOC_CAP_8BIT);
+        setup_complete.store(true);
+    }
+
+    uint32_t runtimeAllocations()
+    {
+        return runtime_allocs.load(std::memory_order_relaxed);
+    }
+
+    int32_t heapDeltaSinceSetup()
+    {
+        if (!setup_complete.load()) {
+            return 0;
+        }
+        return (int32_t)free_heap_at_setup - (int32_t)heap_caps_get_free_size(MALLOC_CAP_8BIT);
+    }
+
+    void printReport()
+    {
+        Serial.println("=== Memory ===");
+        for (uint8_t i = 0; i < num_tasks; i++) {
+            // ESP-IDF reports stack depth in bytes
+            uint32_t free_bytes = uxTaskGetStackHighWaterMark(tasks[i].handle);
+            Serial.printf("%-16s used %5lu / %5lu B\n",
+                          pcTaskGetName(tasks[i].handle),
+                          (unsigned long)(tasks[i].stack_size - free_bytes),
+                          (unsigned long)tasks[i].stack_size);
+        }
+        Serial.printf("Heap free %lu B (at setup %lu B)\n",
+                      (unsigned long)heap_caps_get_free_size(MALLOC_CAP_8BIT),
+                      (unsigned long)free_heap_at_setup);
+        Serial.printf("Heap min free %lu B\n",
+                      (unsigned long)heap_caps_get_minimum_free_size(MALLOC_CAP_8BIT));
+        // the free heap delta also catches allocators the hooks cannot see (e.g. newlib internals)
+        Serial.printf("Heap used since setup %ld B\n", (long)heapDeltaSinceSetup());
+        Serial.printf("Runtime allocations: %lu\n", (unsigned long)runtimeAllocations());
+        if (runtimeAllocations() > 0) {
+            Serial.printf("Last allocation from %p\n", last_alloc_caller.load());
+        }
+        Serial.println("==============");
+    }
+}
+
+// allocation counting hooks, linked in with -Wl,--wrap. all of them live in IRAM like the
+// newlib and heap_caps allocators they replace, which may be called with the flash cache disabled
+extern "C" {
+    void* IRAM_ATTR __wrap_malloc(size_t size)
+    {
+        diagnostics::memory::countAllocation(__builtin_return_address(0));
+        return __real_malloc(size);
+    }
+
+    void* IRAM_ATTR __wrap_calloc(size_t n, size_t size)
+    {
+        diagnostics::memory::countAllocation(__builtin_return_address(0));
+        return __real_calloc(n, size);
+    }
+
+    void* IRAM_ATTR __wrap_realloc(void* ptr, size_t size)
+    {
+        diagnostics::memory::countAllocation(__builtin_return_address(0));
+        return __real_realloc(ptr, size);
+    }
+
+    // FreeRTOS (pvPortMalloc), the kernel object create calls and most IDF drivers allocate here directly
+    void* IRAM_ATTR __wrap_heap_caps_malloc(size_t size, uint32_t caps)
+    {
+        diagnostics::memory::countAllocation(__builtin_return_address(0));
+        return __real_heap_caps_malloc(size, caps);
+    }
+
+    void* IRAM_ATTR __wrap_heap_caps_calloc(size_t n, size_t size, uint32_t caps)
+    {
+        diagnostics::memory::countAllocation(__builtin_return_address(0));
+        return __real_heap_caps_calloc(n, size, caps);
+    }
+
+    void* IRAM_ATTR __wrap_heap_caps_realloc(void* ptr, size_t size, uint32_t caps)
+    {
+        diagnostics::memory::countAllocation(__builtin_return_address(0));
+        return __real_heap_caps_realloc(ptr, size, caps);
+    }
+
+    // variadic, so the capability list can't be forwarded: try each in order like the IDF implementation
+    void* IRAM_ATTR __wrap_heap_caps_malloc_prefer(size_t size, size_t num, ...)
+    {
+        diagnostics::memory::countAllocation(__builtin_return_address(0));
+        void* ptr = NULL;
+        va_list argp;
+        va_start(argp, num);
+        while (num-- > 0 && ptr == NULL) {
+            uint32_t caps = va_arg(argp, uint32_t);
+            ptr = __real_heap_caps_malloc(size, caps);
+        }
+        va_end(argp);
+        return ptr;
+    }
+}
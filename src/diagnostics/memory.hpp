@@ -0,0 +1,27 @@
+#ifndef MEMORY_HPP
+#define MEMORY_HPP
+
+#include <Arduino.h>
+
+#define MEM_MAX_TASKS 8
+
+// runtime memory budget checks: stack high-water marks of the statically allocated tasks
+// and a count of heap allocations made after setup(), collected by wrapping malloc/calloc/realloc
+// and the heap_caps allocators at link time (see build_flags in platformio.ini), cross-checked
+// against the change in free heap since setup()
+namespace diagnostics::memory
+{
+    // add a task to the stack report, stack_size in bytes as passed to xTaskCreateStatic
+    void registerTask(TaskHandle_t handle, uint32_t stack_size);
+
+    // call at the end of setup() on the loop task, any allocation after this is counted as a runtime allocation.
+    // other tasks that format floats must have done so once before this for the heap delta to stay at zero
+    void markSetupComplete();
+
+    uint32_t runtimeAllocations();
+    // bytes of heap in use now that were free at the end of setup(), should stay at zero
+    int32_t heapDeltaSinceSetup();
+    void printReport();
+}
+
+#endif // MEMORY_HPP
@@ -1,6 +1,9 @@
 #include "main.hpp"
 #include "sensors/encoder.hpp"
 #include "control/rotor_control.hpp"
+#include "thrust_map.hpp"
+#include "comms/setpoint_link.hpp"
+#include "diagnostics/memory.hpp"
 #include <Arduino.h>
 
 
@@ -16,6 +19,16 @@ float roll_command = 0.0f;
 float pitch_command = 0.03f;
 float thrust_command = 0.10f;
 
+// strip surrounding whitespace in place, returns the new length
+static size_t trimInput(char* input, size_t len) {
+    size_t start = 0;
+    while (start < len && isspace((unsigned char)input[start])) start++;
+    while (len > start && isspace((unsigned char)input[len - 1])) len--;
+    memmove(input, input + start, len - start);
+    input[len - start] = '\0';
+    return len - start;
+}
+
 void setup() 
 {
     Serial.begin(921600);   
@@ -28,6 +41,8 @@ void setup()
     sensors::encoder::initEncoder();
     // initialize rotor control
     control::rotor::initRotor();
+    // initialize flight controller setpoint link
+    comms::setpoint::initLink();
 
     delay(2000);
     
@@ -39,8 +54,14 @@ void setup()
     Serial.println("  r<value> - Set roll command (e.g., r0.03)");
     Serial.println("  p<value> - Set pitch command (e.g., p0.05)");
     Serial.println("  t<value> - Set thrust command (e.g., t0.12)");
+    Serial.println("  (while ACTIVE, setpoints from the UART link override r/p/t)");
+    Serial.println("  b - Benchmark thrust map lookup");
+    Serial.println("  m - Show stack and heap usage");
     Serial.println("  ? - Show current status");
     Serial.println("========================");
+
+    // everything is allocated by now, any later heap use is reported by the 'm' command
+    diagnostics::memory::markSetupComplete();
 }
 
 void processSerialInput() {
@@ -57,10 +78,12 @@ void processSerialInput() {
                 switch (pending_command) {
                     case 's':
                         state = State::ACTIVE;
+                        comms::setpoint::setArmed(true);
                         Serial.println("CONFIRMED - Motor ACTIVE");
                         break;
                     case 'x':
                         state = State::IDLE;
+                        comms::setpoint::setArmed(false);
                         Serial.println("CONFIRMED - Motor IDLE");
                         break;
                     case 'r':
@@ -86,12 +109,14 @@ void processSerialInput() {
             return;
         }
         
-        String input = Serial.readStringUntil('\n');
-        input.trim();
+        // fixed buffer rather than String so the console does not allocate at runtime
+        static char input[32];
+        size_t input_length = Serial.readBytesUntil('\n', input, sizeof(input) - 1);
+        input_length = trimInput(input, input_length);
         
-        if (input.length() == 0) return;
+        if (input_length == 0) return;
         
-        char command = input.charAt(0);
+        char command = input[0];
         
         switch (command) {
             case 's':
@@ -112,8 +137,8 @@ void processSerialInput() {
                 
             case 'r':
             case 'R':
-                if (input.length() > 1) {
-                    float new_roll = input.substring(1).toFloat();
+                if (input_length > 1) {
+                    float new_roll = strtof(&input[1], NULL);
                     Serial.printf("Command: Set roll to %.3f (current: %.3f)\n", new_roll, roll_command);
                     Serial.print("Confirm? (y/n): ");
                     waiting_for_confirmation = true;
@@ -126,8 +151,8 @@ void processSerialInput() {
                 
             case 'p':
             case 'P':
-                if (input.length() > 1) {
-                    float new_pitch = input.substring(1).toFloat();
+                if (input_length > 1) {
+                    float new_pitch = strtof(&input[1], NULL);
                     Serial.printf("Command: Set pitch to %.3f (current: %.3f)\n", new_pitch, pitch_command);
                     Serial.print("Confirm? (y/n): ");
                     waiting_for_confirmation = true;
@@ -140,8 +165,8 @@ void processSerialInput() {
                 
             case 't':
             case 'T':
-                if (input.length() > 1) {
-                    float new_thrust = input.substring(1).toFloat();
+                if (input_length > 1) {
+                    float new_thrust = strtof(&input[1], NULL);
                     Serial.printf("Command: Set thrust to %.3f (current: %.3f)\n", new_thrust, thrust_command);
                     Serial.print("Confirm? (y/n): ");
                     waiting_for_confirmation = true;
@@ -152,6 +177,25 @@ void processSerialInput() {
                 }
                 break;
                 
+            case 'b':
+            case 'B': {
+                float cycles = control::rotor::benchmarkThrustMap(10000);
+                Serial.printf("Thrust map lookup: %.1f cycles/call (%.3f us @ %lu MHz)\n",
+                              cycles, cycles / getCpuFrequencyMhz(), (unsigned long)getCpuFrequencyMhz());
+                const uint16_t* table = control::thrust_map::table();
+                Serial.print("Table:");
+                for (int i = 0; i <= THRUST_MAP_SEGMENTS; i++) {
+                    Serial.printf(" %u", table[i]);
+                }
+                Serial.println();
+                break;
+            }
+
+            case 'm':
+            case 'M':
+                diagnostics::memory::printReport();
+                break;
+
             case '?':
                 Serial.println("=== Current Status ===");
                 Serial.printf("State: %s\n", (state == State::ACTIVE) ? "ACTIVE" : "IDLE");
@@ -159,6 +203,8 @@ void processSerialInput() {
                 Serial.printf("Pitch Command: %.3f\n", pitch_command);
                 Serial.printf("Thrust Command: %.3f\n", thrust_command);
                 Serial.printf("Encoder Angle: %.3f rad\n", sensors::encoder::enc_angle_rad.load());
+                sensors::encoder::printStatus();
+                comms::setpoint::printStats();
                 Serial.println("====================");
                 break;
                 
@@ -181,6 +227,14 @@ void loop()
     }
 
     
+    // link timed out while driving the rotor, it has already cut the setpoints.
+    // active is read before the failsafe so a timeout in between cannot let console setpoints through
+    bool link_active = comms::setpoint::isActive();
+    if (comms::setpoint::takeFailsafe() && state == State::ACTIVE) {
+        state = State::IDLE;
+        Serial.println("FAILSAFE - Setpoint link lost, motor IDLE");
+    }
+
     // Apply current state
     switch (state)
     {
@@ -189,7 +243,10 @@ void loop()
             break;
 
         case State::ACTIVE:
-            control::rotor::setControlInputs(roll_command, pitch_command, 0.0, thrust_command);
+            // the link task applies its own setpoints at frame rate
+            if (!link_active) {
+                control::rotor::setControlInputs(roll_command, pitch_command, 0.0, thrust_command);
+            }
             break;
 
 
@@ -1,14 +1,20 @@
 #include "encoder.hpp"
 #include "as5600.hpp"
+#include "diagnostics/memory.hpp"
 #include <Arduino.h>
 
 namespace sensors::encoder
 {
-    AS5600 magEnc(I2C_ADDRESS_AS5600);
-    static TwoWire magI2C = TwoWire(0);
-    static TaskHandle_t encoderTaskHandle = NULL;
+    static EncoderChannel channels[ENC_NUM_CHANNELS] = {
+        {0, PIN_ENC_SDA, PIN_ENC_SCL},
+        {1, PIN_ENC2_SDA, PIN_ENC2_SCL},
+    };
 
     static hw_timer_t* encoderTimer = NULL;
+    static volatile uint8_t next_channel = 0;
+
+    // consecutive samples where both healthy channels were self-consistent but disagreed with each other
+    static std::atomic<uint16_t> xcheck_streak{0};
 
 #ifdef LOG_ENCODER
     // circular logging buffer
@@ -17,37 +23,158 @@ namespace sensors::encoder
     static uint32_t log_timestamps[LOG_SIZE];
     static volatile uint16_t log_index = 0;
     static volatile bool log_full = false;
+    static portMUX_TYPE log_mux = portMUX_INITIALIZER_UNLOCKED; // both channel tasks write the log
 
     static TaskHandle_t logTaskHandle = NULL;
+    static StaticTask_t log_task_buffer;
+    static StackType_t log_task_stack[ENC_LOG_TASK_STACK_SIZE];
 #endif
 
+    // wrap an angle difference to [-pi, pi)
+    static inline float wrapAngle(float a) {
+        while (a >= M_PI) a -= 2.0f * M_PI;
+        while (a < -M_PI) a += 2.0f * M_PI;
+        return a;
+    }
+
     void IRAM_ATTR onEncoderTimer() {
         BaseType_t xHigherPriorityTaskWoken = pdFALSE;
-        // notify the encoder task to run
-        vTaskNotifyGiveFromISR(encoderTaskHandle, &xHigherPriorityTaskWoken);
+        // alternate between channels so the two sample streams interleave,
+        // falling back to whichever sensor is present if one is missing
+        TaskHandle_t handle = channels[next_channel].taskHandle;
+        next_channel = (next_channel + 1) % ENC_NUM_CHANNELS;
+        if (handle == NULL) {
+            handle = channels[next_channel].taskHandle;
+        }
+        if (handle != NULL) {
+            // notify the encoder task to run
+            vTaskNotifyGiveFromISR(handle, &xHigherPriorityTaskWoken);
+        }
         if (xHigherPriorityTaskWoken == pdTRUE) {
             portYIELD_FROM_ISR();
         }
     }
 
-    void initEncoder()
+    static bool setupChannel(EncoderChannel& ch)
     {
-        magI2C.begin(PIN_ENC_SDA, PIN_ENC_SCL);
-        magI2C.setClock(400000);
-        
+        ch.wire.begin(ch.pin_sda, ch.pin_scl);
+        ch.wire.setClock(400000);
+
         // confirm I2C is working
-        magI2C.beginTransmission(I2C_ADDRESS_AS5600);
+        ch.wire.beginTransmission(I2C_ADDRESS_AS5600);
         delay(100);
-        uint8_t error = magI2C.endTransmission();
+        uint8_t error = ch.wire.endTransmission();
         if (error != 0) {
-            Serial.println("[Encoder]: ERROR - Cannot communicate with AS5600!");
+            Serial.printf("[Encoder]: ERROR - Cannot communicate with AS5600 on channel %u!\n", ch.index);
+            return false;
+        }
+        return true;
+    }
+
+    // runs in the channel's own task: once closeTransactions is off the AS5600 keeps the bus
+    // (and the TwoWire mutex) held by the calling task between reads
+    static void configureSensor(EncoderChannel& ch)
+    {
+        // initialize AS5600 I2C comms
+        ch.sensor.init(&ch.wire);
+
+        // configure the AS5600 for max speed
+        AS5600Conf ASconf;
+        ASconf.sf = 0b11;
+        ASconf.fth = 0b000;
+        ch.sensor.setConf(ASconf);
+        ch.sensor.closeTransactions = false;
+
+        // test single read
+        AS5600Conf regs = ch.sensor.readConf();
+        Serial.printf("[Encoder]: Channel %u SF = %u FTH = %u\n", ch.index, regs.sf, regs.fth);
+    }
+
+    // average this channel's angle while the rotor is stationary, channel 1 then takes its
+    // mounting offset relative to channel 0 (assumes both sensors are mounted with the same direction)
+    static void calibrateOffset(EncoderChannel& ch)
+    {
+        float sum_sin = 0.0f;
+        float sum_cos = 0.0f;
+        int good = 0;
+        // failed reads return garbage, skip them and retry up to a bounded number of attempts
+        for (int i = 0; i < ENC_OFFSET_SAMPLES * 4 && good < ENC_OFFSET_SAMPLES; i++) {
+            float a = ch.sensor.readRawAngle() * AS5600_RAW_TO_RAD;
+            if (ch.sensor.lastReadOk) {
+                sum_sin += sin(a);
+                sum_cos += cos(a);
+                good++;
+            }
+            vTaskDelay(1);
+        }
+        if (good < ENC_OFFSET_SAMPLES) {
+            // stays unhealthy, its offset is unknown so it could never agree with the other channel
+            Serial.printf("[Encoder]: ERROR - Channel %u calibration failed (%d/%d reads)\n",
+                          ch.index, good, ENC_OFFSET_SAMPLES);
+            ch.calibrated.store(true);
+            return;
+        }
+        float mean = atan2(sum_sin, sum_cos);
+        if (mean < 0.0f) mean += 2.0f * M_PI;
+        ch.startup_angle_rad.store(mean);
+
+        if (ch.index == 1 && channels[0].present) {
+            while (!channels[0].calibrated.load()) {
+                vTaskDelay(1);
+            }
+            if (channels[0].calibration_ok.load()) {
+                ch.offset_rad = wrapAngle(mean - channels[0].startup_angle_rad.load());
+                Serial.printf("[Encoder]: Channel 1 offset = %.4f rad\n", ch.offset_rad);
+            } else {
+                Serial.println("[Encoder]: WARNING - Channel 0 not calibrated, channel 1 offset unknown");
+            }
+        }
+
+        // seed the published state so the other channel has something valid to cross-check against
+        float angle = mean - ch.offset_rad;
+        if (angle < 0.0f) angle += 2.0f * M_PI;
+        if (angle >= 2.0f * M_PI) angle -= 2.0f * M_PI;
+        ch.angle_rad.store(angle);
+        ch.velocity_rad_s.store(0.0f);
+        ch.timestamp_us.store(micros());
+        ch.calibration_ok.store(true);
+        ch.calibrated.store(true);
+        ch.healthy.store(true);
+    }
+
+    // true if the sensor itself reports a missing, weak or saturated magnet
+    static bool magnetFault(EncoderChannel& ch)
+    {
+        AS5600Status status = ch.sensor.readStatus();
+        return !ch.sensor.lastReadOk || !status.md || status.ml || status.mh;
+    }
+
+    void initEncoder()
+    {
+        // channels become healthy once their task has configured and calibrated the sensor
+        for (auto& ch : channels) {
+            ch.present = setupChannel(ch);
+        }
+        if (!channels[0].present && !channels[1].present) {
+            Serial.println("[Encoder]: ERROR - No encoder available!");
             return;
         }
-        
+        if (!channels[0].present || !channels[1].present) {
+            Serial.println("[Encoder]: WARNING - Running on a single encoder, no redundancy");
+        }
+
         // start freertos tasks
-        xTaskCreate(encoderTask, "EncoderTask", 4096, NULL, 3, &encoderTaskHandle);
+        for (auto& ch : channels) {
+            if (ch.present) {
+                char name[16];
+                snprintf(name, sizeof(name), "EncoderTask%u", ch.index);
+                ch.taskHandle = xTaskCreateStatic(encoderTask, name, ENC_TASK_STACK_SIZE, &ch, 3, ch.taskStack, &ch.taskBuffer);
+                diagnostics::memory::registerTask(ch.taskHandle, ENC_TASK_STACK_SIZE);
+            }
+        }
 #ifdef LOG_ENCODER
-        xTaskCreate(encoderLoggerTask, "LogTask", 4096, NULL, 1, &logTaskHandle);
+        logTaskHandle = xTaskCreateStatic(encoderLoggerTask, "LogTask", ENC_LOG_TASK_STACK_SIZE, NULL, 1, log_task_stack, &log_task_buffer);
+        diagnostics::memory::registerTask(logTaskHandle, ENC_LOG_TASK_STACK_SIZE);
 #endif
 
 
@@ -55,44 +182,186 @@ namespace sensors::encoder
         Serial.println("[Encoder]: Setting up timer");
         encoderTimer = timerBegin(1000000); // 1 MHz timer
         timerAttachInterrupt(encoderTimer, &onEncoderTimer);
-        timerAlarm(encoderTimer, 1000, true, 0); // 1000 Hz alarm, auto-reload
+        timerAlarm(encoderTimer, 1000000 / ENC_SAMPLE_RATE_HZ, true, 0); // 2000 Hz alarm, auto-reload
         Serial.println("[Encoder]: Encoder initialized.");
     }
 
-    void encoderTask(void *pvParameters)
+    // returns true if this sample agrees with the other channel's latest sample,
+    // propagated forward to now with its velocity estimate
+    static bool crossCheck(const EncoderChannel& ch, float angle_rad, uint32_t now_us)
     {
-        // initialize AS5600 I2C comms
-        magEnc.init(&magI2C);
+        const EncoderChannel& other = channels[(ch.index + 1) % ENC_NUM_CHANNELS];
+        if (!other.present || !other.healthy.load(std::memory_order_relaxed)) {
+            return true; // nothing to compare against
+        }
+        float dt = (int32_t)(now_us - other.timestamp_us.load(std::memory_order_relaxed)) * 1e-6f;
+        float predicted = other.angle_rad.load(std::memory_order_relaxed)
+                        + other.velocity_rad_s.load(std::memory_order_relaxed) * dt;
+        return fabsf(wrapAngle(angle_rad - predicted)) < ENC_XCHECK_TOL_RAD;
+    }
 
-        // configure the AS5600 for max speed
-        AS5600Conf ASconf;
-        ASconf.sf = 0b11;
-        ASconf.fth = 0b000;
-        magEnc.setConf(ASconf); 
-        magEnc.closeTransactions = false;
+    void encoderTask(void *pvParameters)
+    {
+        EncoderChannel& ch = *static_cast<EncoderChannel*>(pvParameters);
+        float prev_angle = 0.0f;
+        float prev_velocity = 0.0f;
+        uint32_t prev_time = 0;
+        bool have_prev = false;
 
-        // test single read
-        AS5600Conf regs = magEnc.readConf();
-        Serial.println("[Encoder]: SF = " + String(regs.sf, BIN) + " FTH = " + String(regs.fth, BIN));
+        configureSensor(ch);
+        calibrateOffset(ch);
 
         while(1){
             ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
 
-            float angle_rad = magEnc.readRawAngle() * AS5600_RAW_TO_RAD;
+            uint16_t raw = ch.sensor.readRawAngle();
+            uint32_t now = micros();
+            ch.samples++;
+
+            bool sample_ok = ch.sensor.lastReadOk;
+            float angle_rad = 0.0f;
+            if (sample_ok) {
+                angle_rad = raw * AS5600_RAW_TO_RAD - ch.offset_rad;
+                if (angle_rad < 0.0f) angle_rad += 2.0f * M_PI;
+                if (angle_rad >= 2.0f * M_PI) angle_rad -= 2.0f * M_PI;
+            } else {
+                ch.read_errors++;
+            }
+
+            if (sample_ok && have_prev) {
+                // a sample that disagrees with the other sensor is blamed on whichever
+                // channel deviates more from its own constant-velocity prediction
+                // (a channel that is already faulted has to agree before it is trusted again)
+                float dt = (now - prev_time) * 1e-6f;
+                if (crossCheck(ch, angle_rad, now)) {
+                    xcheck_streak.store(0, std::memory_order_relaxed);
+                } else {
+                    float own_residual = fabsf(wrapAngle(angle_rad - (prev_angle + prev_velocity * dt)));
+                    if (own_residual >= ENC_XCHECK_TOL_RAD || !ch.healthy.load(std::memory_order_relaxed)) {
+                        sample_ok = false;
+                        ch.xcheck_faults++;
+                    } else {
+                        // both sensors look fine on their own (e.g. one stuck at low speed, slipped magnet)
+                        xcheck_streak.fetch_add(1, std::memory_order_relaxed);
+                    }
+                }
+            }
+
+            // persistent disagreement: each channel reads its own magnet status (the bus belongs to this task),
+            // then channel 0 weighs the evidence from both and asks one or both channels to fault
+            uint16_t streak = xcheck_streak.load(std::memory_order_relaxed);
+            if (streak == 0) {
+                ch.status_valid.store(false, std::memory_order_relaxed);
+            } else if (streak >= ENC_XCHECK_FAULT_COUNT && !ch.status_valid.load(std::memory_order_relaxed)) {
+                ch.magnet_fault.store(magnetFault(ch), std::memory_order_relaxed);
+                ch.status_valid.store(true, std::memory_order_relaxed);
+            }
+            if (ch.index == 0 && streak >= ENC_XCHECK_FAULT_COUNT) {
+                EncoderChannel& other = channels[1];
+                // wait for the other channel's status, but not forever
+                if (other.status_valid.load() || streak >= 2 * ENC_XCHECK_FAULT_COUNT) {
+                    ChannelEvidence ev[ENC_NUM_CHANNELS];
+                    for (uint8_t i = 0; i < ENC_NUM_CHANNELS; i++) {
+                        ev[i].status_valid = channels[i].status_valid.load();
+                        ev[i].magnet_fault = channels[i].magnet_fault.load();
+                        ev[i].velocity_rad_s = channels[i].velocity_rad_s.load();
+                    }
+                    uint8_t mask = arbitrate(ev[0], ev[1], enc_rotor_driven.load(std::memory_order_relaxed));
+                    for (uint8_t i = 0; i < ENC_NUM_CHANNELS; i++) {
+                        if (mask & (1 << i)) {
+                            channels[i].fault_request.store(true);
+                        }
+                        channels[i].status_valid.store(false);
+                    }
+                    xcheck_streak.store(0, std::memory_order_relaxed);
+                }
+            }
+            if (ch.fault_request.exchange(false)) {
+                sample_ok = false;
+                ch.xcheck_faults++;
+                ch.bad_count = ENC_FAULT_COUNT - 1; // fault immediately below
+            }
+
+            if (sample_ok && have_prev) {
+                float dt = (now - prev_time) * 1e-6f;
+                if (dt > 0.0f) {
+                    prev_velocity = wrapAngle(angle_rad - prev_angle) / dt;
+                }
+            }
+
+            if (sample_ok) {
+                prev_angle = angle_rad;
+                prev_time = now;
+                have_prev = true;
+                ch.angle_rad.store(angle_rad, std::memory_order_relaxed);
+                ch.velocity_rad_s.store(prev_velocity, std::memory_order_relaxed);
+                ch.timestamp_us.store(now, std::memory_order_relaxed);
+                ch.bad_count = 0;
+                if (ch.good_count < ENC_RECOVER_COUNT) {
+                    ch.good_count++;
+                }
+            } else {
+                ch.good_count = 0;
+                if (ch.bad_count < ENC_FAULT_COUNT) {
+                    ch.bad_count++;
+                }
+            }
+
+            // fail over: an unhealthy channel keeps being read so it can recover, but is not published
+            bool healthy = ch.healthy.load(std::memory_order_relaxed);
+            if (healthy && ch.bad_count >= ENC_FAULT_COUNT) {
+                ch.healthy.store(false, std::memory_order_relaxed);
+                healthy = false;
+            } else if (!healthy && ch.good_count >= ENC_RECOVER_COUNT) {
+                ch.healthy.store(true, std::memory_order_relaxed);
+                healthy = true;
+            }
+            if (!healthy || !sample_ok) {
+                continue;
+            }
+
+            // while the sensors disagree only the primary (lowest healthy) channel is published
+            if (xcheck_streak.load(std::memory_order_relaxed) > 0 && ch.index != 0
+                && channels[0].healthy.load(std::memory_order_relaxed)) {
+                continue;
+            }
+
             enc_angle_rad.store(angle_rad, std::memory_order_relaxed);
 
 #ifdef LOG_ENCODER
+            bool log_wrapped = false;
+            portENTER_CRITICAL(&log_mux);
             log_buffer[log_index] = angle_rad;
             log_timestamps[log_index] = millis();
             log_index++;
-            
-            // notify log task when buffer is full
             if (log_index >= LOG_SIZE) {
                 log_index = 0;
+                log_wrapped = true;
+            }
+            portEXIT_CRITICAL(&log_mux);
+
+            // notify log task when buffer is full
+            if (log_wrapped) {
                 xTaskNotifyGive(logTaskHandle);
             }
 #endif
-            
+
+        }
+    }
+
+    void printStatus()
+    {
+        for (const auto& ch : channels) {
+            // kept under 64 chars per line so Print::printf does not fall back to the heap
+            Serial.printf("Encoder %u: %s, %s, angle %.3f rad\n",
+                          ch.index,
+                          ch.present ? "present" : "missing",
+                          ch.healthy.load() ? "healthy" : "FAULT",
+                          ch.angle_rad.load());
+            Serial.printf("  samples %lu, read errors %lu\n",
+                          (unsigned long)ch.samples,
+                          (unsigned long)ch.read_errors);
+            Serial.printf("  cross-check faults %lu\n", (unsigned long)ch.xcheck_faults);
         }
     }
 
@@ -112,12 +381,12 @@ namespace sensors::encoder
             memcpy(local_timestamps, (void*)log_timestamps, sizeof(log_timestamps));
             // Print all data
             for (uint16_t i = 0; i < LOG_SIZE; i++) {
-                Serial.printf("%lu,%.4f\n", 
-                             local_timestamps[i], 
+                Serial.printf("%lu,%.4f\n",
+                             local_timestamps[i],
                              local_buffer[i]);
             }
         }
     }
 #endif
-    
-}
\ No newline at end of file
+
+}
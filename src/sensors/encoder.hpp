@@ -2,23 +2,80 @@
 #define ENCODER_HPP
 
 #include <atomic>
+#include <Arduino.h>
+#include <Wire.h>
+#include "as5600.hpp"
+#include "encoder_arbitration.hpp"
 
 #define PIN_ENC_SDA 6
 #define PIN_ENC_SCL 7 // haha funny number
+#define PIN_ENC2_SDA 15 // redundant encoder on the second I2C controller
+#define PIN_ENC2_SCL 16
 #define PIN_ENC_DIR 4 // direction on pin 4
 #define I2C_ADDRESS_AS5600 0x36
 
 #define AS5600_RAW_TO_RAD (2.0f * M_PI / 4096.0f)
 
+#define ENC_NUM_CHANNELS 2
+#define ENC_SAMPLE_RATE_HZ 2000 // combined rate, channels are read alternately at half this each
+#define ENC_XCHECK_TOL_RAD 0.15f // max disagreement between the two sensors before one is faulted
+#define ENC_FAULT_COUNT 3 // consecutive bad samples before a channel is marked unhealthy
+#define ENC_RECOVER_COUNT 100 // consecutive good samples before an unhealthy channel is trusted again
+#define ENC_XCHECK_FAULT_COUNT 20 // consecutive disagreements between two self-consistent sensors before one is faulted
+#define ENC_OFFSET_SAMPLES 64 // samples averaged at startup to find the mounting offset between sensors
+#define ENC_TASK_STACK_SIZE 4096 // bytes, only shrink based on high-water marks measured with the 'm' console command
+#define ENC_LOG_TASK_STACK_SIZE 4096
+
 //#define LOG_ENCODER // enable encoder logging task
 
 namespace sensors::encoder
 {
+    // one AS5600 on its own I2C controller, read by its own task
+    struct EncoderChannel {
+        uint8_t index;
+        TwoWire wire;
+        AS5600 sensor;
+        int pin_sda;
+        int pin_scl;
+        bool present = false;
+        TaskHandle_t taskHandle = NULL;
+        StaticTask_t taskBuffer;
+        StackType_t taskStack[ENC_TASK_STACK_SIZE];
+
+        float offset_rad = 0.0f; // mounting offset relative to channel 0
+        std::atomic<float> startup_angle_rad{0.0f}; // averaged while stationary, used to find the offset
+        std::atomic<bool> calibrated{false};
+        std::atomic<bool> calibration_ok{false};
+
+        // disagreement arbitration: each task reads its own magnet status, channel 0 decides
+        std::atomic<bool> status_valid{false};
+        std::atomic<bool> magnet_fault{false};
+        std::atomic<bool> fault_request{false};
+
+        // latest sample, written by the channel task and read by the other channel for the cross-check
+        std::atomic<float> angle_rad{0.0f};
+        std::atomic<float> velocity_rad_s{0.0f};
+        std::atomic<uint32_t> timestamp_us{0};
+        std::atomic<bool> healthy{false};
+
+        // diagnostics
+        uint8_t bad_count = 0;
+        uint16_t good_count = 0;
+        uint32_t read_errors = 0;
+        uint32_t xcheck_faults = 0;
+        uint32_t samples = 0;
+
+        EncoderChannel(uint8_t index, int pin_sda, int pin_scl)
+            : index(index), wire(index), sensor(I2C_ADDRESS_AS5600), pin_sda(pin_sda), pin_scl(pin_scl) {}
+    };
+
     inline std::atomic<float> enc_angle_rad;
+    inline std::atomic<bool> enc_rotor_driven{false}; // set by rotor control while the motor is commanded to spin
 
     void initEncoder();
     void encoderTask(void *pvParameters);
     void encoderLoggerTask(void *pvParameters);
+    void printStatus();
 }
 
-#endif // ENCODER_HPP
\ No newline at end of file
+#endif // ENCODER_HPP
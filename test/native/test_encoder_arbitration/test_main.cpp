@@ -0,0 +1,68 @@
+// host tests for the dual encoder fault arbitration, run with: pio test -e native
+#include <unity.h>
+#include "encoder_arbitration.hpp"
+
+using namespace sensors::encoder;
+
+static ChannelEvidence evidence(float velocity, bool magnet_fault = false, bool status_valid = true)
+{
+    ChannelEvidence ev;
+    ev.status_valid = status_valid;
+    ev.magnet_fault = magnet_fault;
+    ev.velocity_rad_s = velocity;
+    return ev;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_magnet_fault_wins()
+{
+    TEST_ASSERT_EQUAL_HEX8(0x01, arbitrate(evidence(100.0f, true), evidence(100.0f), false));
+    TEST_ASSERT_EQUAL_HEX8(0x02, arbitrate(evidence(100.0f), evidence(100.0f, true), false));
+    TEST_ASSERT_EQUAL_HEX8(0x03, arbitrate(evidence(100.0f, true), evidence(100.0f, true), false));
+
+    // a magnet fault outranks velocity evidence pointing at the other channel
+    TEST_ASSERT_EQUAL_HEX8(0x02, arbitrate(evidence(0.0f), evidence(100.0f, true), true));
+}
+
+void test_unread_status_is_ignored()
+{
+    TEST_ASSERT_EQUAL_HEX8(0x02, arbitrate(evidence(100.0f, true, false), evidence(100.0f), false));
+}
+
+void test_frozen_primary_is_faulted()
+{
+    // channel 0 stuck while channel 1 tracks a spinning rotor
+    TEST_ASSERT_EQUAL_HEX8(0x01, arbitrate(evidence(0.0f), evidence(150.0f), false));
+    TEST_ASSERT_EQUAL_HEX8(0x01, arbitrate(evidence(0.0f), evidence(-150.0f), false));
+    // channel 1 barely moving, but the motor is being driven
+    TEST_ASSERT_EQUAL_HEX8(0x01, arbitrate(evidence(0.0f), evidence(5.0f), true));
+}
+
+void test_frozen_secondary_is_faulted()
+{
+    TEST_ASSERT_EQUAL_HEX8(0x02, arbitrate(evidence(150.0f), evidence(0.0f), false));
+    TEST_ASSERT_EQUAL_HEX8(0x02, arbitrate(evidence(5.0f), evidence(0.5f), true));
+}
+
+void test_no_evidence_keeps_primary()
+{
+    // both moving (e.g. slipped magnet or offset drift on one of them)
+    TEST_ASSERT_EQUAL_HEX8(0x02, arbitrate(evidence(100.0f), evidence(100.0f), true));
+    // both still, rotor idle: a frozen sensor can't be told apart from a stopped rotor
+    TEST_ASSERT_EQUAL_HEX8(0x02, arbitrate(evidence(0.0f), evidence(0.0f), false));
+    // one slow, one still, rotor idle: not enough to blame the still one
+    TEST_ASSERT_EQUAL_HEX8(0x02, arbitrate(evidence(0.0f), evidence(5.0f), false));
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_magnet_fault_wins);
+    RUN_TEST(test_unread_status_is_ignored);
+    RUN_TEST(test_frozen_primary_is_faulted);
+    RUN_TEST(test_frozen_secondary_is_faulted);
+    RUN_TEST(test_no_evidence_keeps_primary);
+    return UNITY_END();
+}
@@ -0,0 +1,141 @@
+// host tests for the setpoint frame codec, run with: pio test -e native
+#include <unity.h>
+#include <string.h>
+#include "setpoint_frame.hpp"
+
+using namespace comms::setpoint;
+
+static bool feedAll(FrameDecoder& decoder, const uint8_t* data, size_t len, Setpoint& out, int* frames = nullptr)
+{
+    bool got = false;
+    for (size_t i = 0; i < len; i++) {
+        if (decoder.feed(data[i], out)) {
+            got = true;
+            if (frames) (*frames)++;
+        }
+    }
+    return got;
+}
+
+void setUp() {}
+void tearDown() {}
+
+void test_crc_reference()
+{
+    // CRC-16/CCITT-FALSE check value
+    const uint8_t data[] = {'1', '2', '3', '4', '5', '6', '7', '8', '9'};
+    TEST_ASSERT_EQUAL_HEX16(0x29B1, crc16(data, sizeof(data)));
+}
+
+void test_round_trip()
+{
+    Setpoint in = {1234, 0.03f, -0.05f, 1.2f, 0.4f};
+    uint8_t frame[SETPOINT_FRAME_SIZE];
+    encodeFrame(in, frame);
+
+    FrameDecoder decoder;
+    Setpoint out = {};
+    TEST_ASSERT_TRUE(feedAll(decoder, frame, sizeof(frame), out));
+    TEST_ASSERT_EQUAL_UINT16(1234, out.seq);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f / SETPOINT_ANGLE_SCALE, in.roll, out.roll);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f / SETPOINT_ANGLE_SCALE, in.pitch, out.pitch);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f / SETPOINT_ANGLE_SCALE, in.yaw, out.yaw);
+    TEST_ASSERT_FLOAT_WITHIN(1.0f / SETPOINT_THRUST_SCALE, in.thrust, out.thrust);
+}
+
+void test_saturation()
+{
+    Setpoint in = {0, 10.0f, -10.0f, 0.0f, 2.0f};
+    uint8_t frame[SETPOINT_FRAME_SIZE];
+    encodeFrame(in, frame);
+
+    FrameDecoder decoder;
+    Setpoint out = {};
+    TEST_ASSERT_TRUE(feedAll(decoder, frame, sizeof(frame), out));
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, 32767.0f / SETPOINT_ANGLE_SCALE, out.roll);
+    TEST_ASSERT_FLOAT_WITHIN(1e-3f, -32768.0f / SETPOINT_ANGLE_SCALE, out.pitch);
+    TEST_ASSERT_EQUAL_FLOAT(1.0f, out.thrust);
+}
+
+void test_crc_rejection()
+{
+    Setpoint in = {7, 0.1f, 0.2f, 0.3f, 0.5f};
+    uint8_t frame[SETPOINT_FRAME_SIZE];
+    encodeFrame(in, frame);
+
+    for (size_t i = 2; i < SETPOINT_FRAME_SIZE; i++) {
+        uint8_t corrupt[SETPOINT_FRAME_SIZE];
+        memcpy(corrupt, frame, sizeof(frame));
+        corrupt[i] ^= 0x01;
+
+        FrameDecoder decoder;
+        Setpoint out = {};
+        TEST_ASSERT_FALSE(feedAll(decoder, corrupt, sizeof(corrupt), out));
+        TEST_ASSERT_EQUAL_UINT32(1, decoder.crc_errors);
+    }
+}
+
+void test_resync_after_garbage()
+{
+    Setpoint in = {42, 0.01f, 0.02f, 0.0f, 0.25f};
+    uint8_t frame[SETPOINT_FRAME_SIZE];
+    encodeFrame(in, frame);
+
+    // garbage containing a false sync sequence, then a valid frame
+    uint8_t stream[7 + SETPOINT_FRAME_SIZE] = {0x00, SETPOINT_SYNC0, SETPOINT_SYNC0, SETPOINT_SYNC1, 0x01, 0x02, 0x03};
+    memcpy(&stream[7], frame, sizeof(frame));
+
+    FrameDecoder decoder;
+    Setpoint out = {};
+    int frames = 0;
+    TEST_ASSERT_TRUE(feedAll(decoder, stream, sizeof(stream), out, &frames));
+    TEST_ASSERT_EQUAL_INT(1, frames);
+    TEST_ASSERT_EQUAL_UINT16(42, out.seq);
+
+    // a corrupted frame followed directly by a good one
+    uint8_t corrupt[SETPOINT_FRAME_SIZE];
+    memcpy(corrupt, frame, sizeof(frame));
+    corrupt[5] ^= 0xFF;
+    in.seq = 43;
+    encodeFrame(in, frame);
+    frames = 0;
+    feedAll(decoder, corrupt, sizeof(corrupt), out, &frames);
+    feedAll(decoder, frame, sizeof(frame), out, &frames);
+    TEST_ASSERT_EQUAL_INT(1, frames);
+    TEST_ASSERT_EQUAL_UINT16(43, out.seq);
+}
+
+void test_sequence_wraparound()
+{
+    SequenceTracker tracker;
+    uint32_t lost = 0;
+
+    TEST_ASSERT_TRUE(tracker.accept(65534, lost));
+    TEST_ASSERT_TRUE(tracker.accept(65535, lost));
+    TEST_ASSERT_EQUAL_UINT32(0, lost);
+    TEST_ASSERT_TRUE(tracker.accept(0, lost));
+    TEST_ASSERT_EQUAL_UINT32(0, lost);
+    TEST_ASSERT_TRUE(tracker.accept(3, lost));
+    TEST_ASSERT_EQUAL_UINT32(2, lost);
+
+    // duplicates and frames from before the wrap are stale
+    TEST_ASSERT_FALSE(tracker.accept(3, lost));
+    TEST_ASSERT_FALSE(tracker.accept(65535, lost));
+
+    // after a reset (timeout, sender reboot) any sequence number is accepted again
+    tracker.reset();
+    TEST_ASSERT_TRUE(tracker.accept(65535, lost));
+    TEST_ASSERT_EQUAL_UINT32(0, lost);
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_crc_reference);
+    RUN_TEST(test_round_trip);
+    RUN_TEST(test_saturation);
+    RUN_TEST(test_crc_rejection);
+    RUN_TEST(test_resync_after_garbage);
+    RUN_TEST(test_sequence_wraparound);
+    return UNITY_END();
+}
@@ -0,0 +1,96 @@
+// host tests for the thrust map fit and lookup, run with: pio test -e native
+#include <unity.h>
+#include <math.h>
+#include <string.h>
+#include "thrust_map.hpp"
+
+using namespace control::thrust_map;
+
+#define DSHOT_RANGE (THRUST_MAP_DSHOT_MAX - THRUST_MAP_DSHOT_MIN)
+
+void setUp()
+{
+    resetLinear();
+}
+
+void tearDown() {}
+
+static void assertMonotone()
+{
+    const uint16_t* t = table();
+    for (int i = 1; i <= THRUST_MAP_SEGMENTS; i++) {
+        TEST_ASSERT_TRUE(t[i] >= t[i - 1]);
+    }
+}
+
+void test_linear_map()
+{
+    TEST_ASSERT_EQUAL_UINT16(THRUST_MAP_DSHOT_MIN, thrustToDshot(0.0f));
+    TEST_ASSERT_EQUAL_UINT16(THRUST_MAP_DSHOT_MAX, thrustToDshot(1.0f));
+    TEST_ASSERT_UINT16_WITHIN(1, THRUST_MAP_DSHOT_MIN + 0.1f * DSHOT_RANGE, thrustToDshot(0.1f));
+    TEST_ASSERT_UINT16_WITHIN(1, THRUST_MAP_DSHOT_MIN + 0.5f * DSHOT_RANGE, thrustToDshot(0.5f));
+
+    // out of range inputs are clamped
+    TEST_ASSERT_EQUAL_UINT16(THRUST_MAP_DSHOT_MIN, thrustToDshot(-1.0f));
+    TEST_ASSERT_EQUAL_UINT16(THRUST_MAP_DSHOT_MAX, thrustToDshot(2.0f));
+    assertMonotone();
+}
+
+void test_fit_quadratic_sweep()
+{
+    // ideal rotor, thrust ~ throttle^2, so the fitted map should follow sqrt(thrust)
+    const size_t n = 41;
+    float throttle[n];
+    float thrust[n];
+    for (size_t i = 0; i < n; i++) {
+        throttle[i] = (float)i / (n - 1);
+        thrust[i] = 2.5f * throttle[i] * throttle[i]; // arbitrary unit
+    }
+    TEST_ASSERT_TRUE(fitFromSweep(throttle, thrust, n));
+    assertMonotone();
+
+    TEST_ASSERT_EQUAL_UINT16(THRUST_MAP_DSHOT_MIN, thrustToDshot(0.0f));
+    TEST_ASSERT_EQUAL_UINT16(THRUST_MAP_DSHOT_MAX, thrustToDshot(1.0f));
+    for (float f = 0.05f; f <= 1.0f; f += 0.05f) {
+        float ideal = THRUST_MAP_DSHOT_MIN + sqrtf(f) * DSHOT_RANGE;
+        TEST_ASSERT_FLOAT_WITHIN(0.01f * DSHOT_RANGE, ideal, (float)thrustToDshot(f));
+    }
+}
+
+void test_fit_noisy_sweep_is_monotone()
+{
+    // measured thrust dips at one point, the fit must still produce a usable monotone map
+    const float throttle[] = {0.0f, 0.2f, 0.4f, 0.6f, 0.8f, 1.0f};
+    const float thrust[]   = {0.0f, 0.05f, 0.2f, 0.18f, 0.6f, 1.0f};
+    TEST_ASSERT_TRUE(fitFromSweep(throttle, thrust, 6));
+    assertMonotone();
+    TEST_ASSERT_EQUAL_UINT16(THRUST_MAP_DSHOT_MAX, thrustToDshot(1.0f));
+}
+
+void test_fit_rejects_bad_sweep()
+{
+    uint16_t before[THRUST_MAP_SEGMENTS + 1];
+    memcpy(before, table(), sizeof(before));
+
+    const float throttle[] = {0.0f, 0.5f, 1.0f};
+    const float decreasing_throttle[] = {0.0f, 0.5f, 0.4f};
+    const float thrust[] = {0.0f, 0.3f, 1.0f};
+    const float flat_thrust[] = {0.2f, 0.2f, 0.2f};
+
+    TEST_ASSERT_FALSE(fitFromSweep(throttle, thrust, 1));
+    TEST_ASSERT_FALSE(fitFromSweep(decreasing_throttle, thrust, 3));
+    TEST_ASSERT_FALSE(fitFromSweep(throttle, flat_thrust, 3));
+
+    // the previous table is kept
+    TEST_ASSERT_EQUAL_MEMORY(before, table(), sizeof(before));
+}
+
+int main(int argc, char** argv)
+{
+    UNITY_BEGIN();
+    RUN_TEST(test_linear_map);
+    RUN_TEST(test_fit_quadratic_sweep);
+    RUN_TEST(test_fit_noisy_sweep_is_monotone);
+    RUN_TEST(test_fit_rejects_bad_sweep);
+    return UNITY_END();
+}